@@ -0,0 +1,296 @@
+// codec_bench.c — 編解碼熱點的 micro-benchmark（xor checksum / RLE 壓縮與解壓 / header 驗證）
+//
+// 仿 Google Benchmark：每個 case 自動加倍迭代次數直到超過 min_time，輸出 GB/s 與 cycles/byte；
+// JSON 格式與 Google Benchmark 相容，可直接用其 tools/compare.py 比較兩個 commit 的結果。
+//
+// 編譯（在 packet_c/ 下）: gcc -O2 bench/codec_bench.c -o bench.exe
+// 參數：
+//   --benchmark_filter=<子字串>     只跑名稱含該字串的 case，例如 rle_compress/runny
+//   --benchmark_min_time=<秒>       每個 case 最少量測時間（預設 0.2）
+//   --benchmark_format=json         JSON 輸出到 stdout（預設為表格）
+//   --benchmark_out=<檔名>          另外把 JSON 寫到檔案
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <intrin.h>
+#define HAVE_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#else
+#define HAVE_TSC 0
+#endif
+
+#include "../packet_frame.h"
+#include "../packet_rle.h"
+
+// ---- 計時 ----
+static double now_ns(void){
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER t;
+    if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&t);
+    return (double)t.QuadPart * 1e9 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+#endif
+}
+
+// TSC 為固定頻率計數器，開 turbo 時與實際核心 cycles 會有落差；同一台機器上比較前後差異仍然有效
+static uint64_t now_cycles(void){
+#if HAVE_TSC
+    return (uint64_t)__rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// ---- 測資 ----
+static const int g_sizes[] = { 16, 64, 256, 1024, 4096, 16384, 65536, 262144, 1048576 };
+#define NUM_SIZES ((int)(sizeof(g_sizes)/sizeof(g_sizes[0])))
+#define MAX_SIZE  1048576
+
+enum { DIST_RANDOM, DIST_RUNNY, DIST_TEXT, NUM_DISTS };
+static const char* g_dist_name[NUM_DISTS] = { "random", "runny", "text" };
+
+static uint32_t g_rng = 0x12345678u;
+static uint32_t xorshift32(void){
+    uint32_t x = g_rng;
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    return g_rng = x;
+}
+
+// random：均勻亂數（RLE 最差情況）；runny：1~64 長度的連續相同值；text：英文單字 + 空白/標點
+static void fill_data(unsigned char* buf, int n, int dist){
+    static const char* words[] = {
+        "the", "packet", "relay", "server", "client", "ttl", "ack", "hello", "checksum",
+        "payload", "of", "and", "to", "a", "compressed", "heartbeat", "priority", "frame"
+    };
+    const int nwords = (int)(sizeof(words)/sizeof(words[0]));
+    int i = 0;
+    g_rng = 0x12345678u; // 固定種子，commit 之間的測資一致
+    if (dist == DIST_RANDOM){
+        for (; i < n; ++i) buf[i] = (unsigned char)xorshift32();
+    } else if (dist == DIST_RUNNY){
+        while (i < n){
+            unsigned char v = (unsigned char)xorshift32();
+            int run = 1 + (int)(xorshift32() % 64);
+            for (int k = 0; k < run && i < n; ++k) buf[i++] = v;
+        }
+    } else {
+        while (i < n){
+            const char* w = words[xorshift32() % nwords];
+            for (; *w && i < n; ++w) buf[i++] = (unsigned char)*w;
+            if (i < n) buf[i++] = (xorshift32() % 10 == 0) ? '.' : ' ';
+        }
+    }
+}
+
+// ---- 受測對象 ----
+typedef struct {
+    const unsigned char* in;
+    int inlen;
+    unsigned char* out;
+    int outcap;
+    int frame_len; // header_validate：每個 frame 長度
+} bench_ctx;
+
+static volatile unsigned g_sink; // 避免結果被最佳化掉
+
+// pf_checksum 的長度是 uint16_t（單一封包 payload 上限），大於 64KB 的資料分段計算
+static unsigned run_checksum(const bench_ctx* c){
+    unsigned char s = 0;
+    for (int off = 0; off < c->inlen; off += 0xFFFF){
+        int n = c->inlen - off;
+        if (n > 0xFFFF) n = 0xFFFF;
+        s ^= pf_checksum(c->in + off, (uint16_t)n);
+    }
+    return s;
+}
+
+static unsigned run_rle_compress(const bench_ctx* c){
+    return (unsigned)rle_compress(c->in, c->inlen, c->out, c->outcap);
+}
+
+static unsigned run_rle_decompress(const bench_ctx* c){
+    return (unsigned)rle_decompress(c->in, c->inlen, c->out, c->outcap);
+}
+
+// 連續的 frame 串流，逐一做 magic/長度/checksum 驗證（server 與 relay 收包時的流程）
+static unsigned run_header_validate(const bench_ctx* c){
+    unsigned acc = 0;
+    for (int off = 0; off + c->frame_len <= c->inlen; off += c->frame_len){
+        uint16_t L = 0;
+        acc += (unsigned)pf_validate(c->in + off, c->frame_len, &L) + L;
+    }
+    return acc;
+}
+
+typedef struct {
+    const char* name;
+    unsigned (*fn)(const bench_ctx*);
+} bench_def;
+
+static const bench_def g_benches[] = {
+    { "xor_checksum",    run_checksum },
+    { "rle_compress",    run_rle_compress },
+    { "rle_decompress",  run_rle_decompress },
+    { "header_validate", run_header_validate },
+};
+#define NUM_BENCHES ((int)(sizeof(g_benches)/sizeof(g_benches[0])))
+
+typedef struct {
+    char name[96];
+    long long iters;
+    double ns_per_iter;
+    double bytes;         // 每次迭代處理的（未壓縮）資料量
+    double gb_per_sec;
+    double cycles_per_byte;
+} bench_result;
+
+// 迭代次數逐步放大，直到總時間超過 min_time（同 Google Benchmark 的做法）
+static void measure(const bench_def* b, const bench_ctx* c, double bytes, double min_time_s, bench_result* r){
+    long long iters = 1;
+    double t0, t1;
+    uint64_t c0, c1;
+    for (;;){
+        unsigned acc = 0;
+        t0 = now_ns(); c0 = now_cycles();
+        for (long long i = 0; i < iters; ++i) acc += b->fn(c);
+        c1 = now_cycles(); t1 = now_ns();
+        g_sink = acc;
+        double elapsed = t1 - t0;
+        if (elapsed >= min_time_s * 1e9 || iters >= (1LL << 40)) break;
+        // 依目前速度推估所需次數，最多放大 10 倍
+        double mult = (elapsed > 0) ? (min_time_s * 1e9 * 1.4) / elapsed : 10.0;
+        if (mult > 10.0) mult = 10.0;
+        if (mult < 2.0) mult = 2.0;
+        iters = (long long)((double)iters * mult);
+    }
+    r->iters = iters;
+    r->ns_per_iter = (t1 - t0) / (double)iters;
+    r->bytes = bytes;
+    r->gb_per_sec = bytes / r->ns_per_iter; // bytes/ns == GB/s
+    r->cycles_per_byte = HAVE_TSC ? (double)(c1 - c0) / (bytes * (double)iters) : 0.0;
+}
+
+// ---- 輸出 ----
+static void write_json(FILE* f, const bench_result* rs, int n, double min_time_s){
+    char date[64];
+    time_t tt = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&tt));
+
+    fprintf(f, "{\n  \"context\": {\n");
+    fprintf(f, "    \"date\": \"%s\",\n", date);
+    fprintf(f, "    \"executable\": \"codec_bench\",\n");
+    fprintf(f, "    \"min_time\": %.3f,\n", min_time_s);
+    fprintf(f, "    \"tsc_cycles\": %s\n", HAVE_TSC ? "true" : "false");
+    fprintf(f, "  },\n  \"benchmarks\": [\n");
+    for (int i = 0; i < n; ++i){
+        const bench_result* r = &rs[i];
+        fprintf(f, "    {\n");
+        fprintf(f, "      \"name\": \"%s\",\n", r->name);
+        fprintf(f, "      \"run_name\": \"%s\",\n", r->name);
+        fprintf(f, "      \"run_type\": \"iteration\",\n");
+        fprintf(f, "      \"iterations\": %lld,\n", r->iters);
+        fprintf(f, "      \"real_time\": %.3f,\n", r->ns_per_iter);
+        fprintf(f, "      \"cpu_time\": %.3f,\n", r->ns_per_iter);
+        fprintf(f, "      \"time_unit\": \"ns\",\n");
+        fprintf(f, "      \"bytes_per_second\": %.1f,\n", r->gb_per_sec * 1e9);
+        fprintf(f, "      \"gb_per_second\": %.4f,\n", r->gb_per_sec);
+        fprintf(f, "      \"cycles_per_byte\": %.4f\n", r->cycles_per_byte);
+        fprintf(f, "    }%s\n", (i + 1 < n) ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+static void print_table(const bench_result* r, int header){
+    if (header){
+        printf("%-40s %14s %12s %10s %12s\n", "Benchmark", "Time(ns)", "Iterations", "GB/s", "cycles/B");
+        printf("------------------------------------------------------------------------------------------\n");
+    }
+    printf("%-40s %14.1f %12lld %10.3f %12.3f\n",
+           r->name, r->ns_per_iter, r->iters, r->gb_per_sec, r->cycles_per_byte);
+    fflush(stdout);
+}
+
+int main(int argc, char** argv){
+    const char* filter = NULL;
+    const char* out_path = NULL;
+    double min_time_s = 0.2;
+    int json_stdout = 0;
+
+    for (int i = 1; i < argc; ++i){
+        if (!strncmp(argv[i], "--benchmark_filter=", 19)) filter = argv[i] + 19;
+        else if (!strncmp(argv[i], "--benchmark_min_time=", 21)) min_time_s = atof(argv[i] + 21);
+        else if (!strcmp(argv[i], "--benchmark_format=json")) json_stdout = 1;
+        else if (!strncmp(argv[i], "--benchmark_out=", 16)) out_path = argv[i] + 16;
+        else { fprintf(stderr, "unknown option: %s\n", argv[i]); return 1; }
+    }
+
+    unsigned char* data  = (unsigned char*)malloc(MAX_SIZE);
+    unsigned char* comp  = (unsigned char*)malloc(2 * MAX_SIZE);  // RLE 最差情況 2 倍
+    unsigned char* out   = (unsigned char*)malloc(MAX_SIZE);
+    unsigned char* frames= (unsigned char*)malloc(MAX_SIZE);
+    bench_result* results = (bench_result*)malloc(sizeof(bench_result) * NUM_BENCHES * NUM_DISTS * NUM_SIZES);
+    if (!data || !comp || !out || !frames || !results){ fprintf(stderr, "out of memory\n"); return 1; }
+    int nres = 0;
+
+    for (int b = 0; b < NUM_BENCHES; ++b){
+        for (int d = 0; d < NUM_DISTS; ++d){
+            for (int si = 0; si < NUM_SIZES; ++si){
+                int size = g_sizes[si];
+                bench_result* r = &results[nres];
+                snprintf(r->name, sizeof(r->name), "BM_%s/%s/%d", g_benches[b].name, g_dist_name[d], size);
+                if (filter && !strstr(r->name, filter)) continue;
+
+                fill_data(data, size, d);
+                bench_ctx c;
+                memset(&c, 0, sizeof(c));
+                double bytes = (double)size;
+
+                if (g_benches[b].fn == run_rle_decompress){
+                    int clen = rle_compress(data, size, comp, 2 * MAX_SIZE);
+                    c.in = comp; c.inlen = clen; c.out = out; c.outcap = MAX_SIZE;
+                } else if (g_benches[b].fn == run_header_validate){
+                    // 把 size 切成數個合法 frame，每個 frame 至多 MAX_PKT
+                    int flen = (size < MAX_PKT) ? size : MAX_PKT;
+                    int off = 0;
+                    for (; off + flen <= size; off += flen)
+                        pf_build(frames + off, flen, TYPE_DATA, PRIO_IMMEDIATE, FLAG_REQUIRE_ACK, 3,
+                                 data + off, (uint16_t)(flen - PF_HDR_LEN - 1));
+                    c.in = frames; c.inlen = size; c.frame_len = flen;
+                    bytes = (double)off;
+                } else {
+                    c.in = data; c.inlen = size; c.out = comp; c.outcap = 2 * MAX_SIZE;
+                }
+
+                measure(&g_benches[b], &c, bytes, min_time_s, r);
+                if (!json_stdout) print_table(r, nres == 0);
+                ++nres;
+            }
+        }
+    }
+
+    if (json_stdout) write_json(stdout, results, nres, min_time_s);
+    if (out_path){
+        FILE* f = fopen(out_path, "w");
+        if (!f){ fprintf(stderr, "cannot open %s\n", out_path); return 1; }
+        write_json(f, results, nres, min_time_s);
+        fclose(f);
+    }
+
+    free(results); free(frames); free(out); free(comp); free(data);
+    return 0;
+}
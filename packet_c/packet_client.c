@@ -6,52 +6,25 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "packet_frame.h"
+#include "packet_rle.h"
+
 #pragma comment(lib, "ws2_32.lib")
 
 // 連線到 Relay
 #define SERVER_IP   "127.0.0.1"
 #define SERVER_PORT 7777
 
-#define MAX_PAYLOAD 1024
-
-// 協定常數
-#define MAGIC1 0xAA
-#define MAGIC2 0xBB
-
-#define TYPE_DATA       0x01
-#define TYPE_HEARTBEAT  0x02
-#define TYPE_ACK        0xA0
-#define TYPE_NACK_SD    0xA1
-
-#define FLAG_REQUIRE_ACK        0x01
-#define FLAG_SELF_DESTRUCT_EN   0x02
-#define FLAG_COMPRESSED         0x04
-
-// 封包內 priority 值
-#define PRIO_DELAYED    0
-#define PRIO_IMMEDIATE  1
-#define PRIO_EPHEMERAL  2
-#define PRIO_MEDIA      3
-
-static unsigned char xor_checksum(const unsigned char* data, uint16_t len){
-    unsigned char s = 0;
-    for (uint16_t i=0; i<len; ++i) s ^= data[i];
-    return s;
-}
+// 送出已封裝好的 frame（payload 可事先就地寫在 pf_payload(pkt)）
+static int send_frame(SOCKET s, const unsigned char* pkt, int plen){
+    if (plen < 0){ fprintf(stderr, "payload too large\n"); return -1; }
+    int n = send(s, (const char*)pkt, plen, 0);
+    if (n == SOCKET_ERROR){ fprintf(stderr, "send error\n"); return -1; }
 
-// 簡易 RLE 壓縮：AAABBB → [5 'A'][3 'B']
-static int rle_compress(const unsigned char* in, int inlen, unsigned char* out, int outcap){
-    int oi = 0;
-    for (int i=0; i<inlen; ){
-        unsigned char v = in[i];
-        int cnt = 1;
-        while (i+cnt < inlen && in[i+cnt]==v && cnt < 255) cnt++;
-        if (oi + 2 > outcap) return -1;
-        out[oi++] = (unsigned char)cnt;
-        out[oi++] = v;
-        i += cnt;
-    }
-    return oi;
+    uint16_t len = (uint16_t)(pkt[6] | (pkt[7]<<8));
+    printf("已送出：type=0x%02X prio=%u flags=0x%02X ttl=%u len=%u\n",
+           pkt[2], pkt[3], pkt[4], pkt[5], len);
+    return 0;
 }
 
 static int send_packet(SOCKET s,
@@ -62,24 +35,9 @@ static int send_packet(SOCKET s,
                        const unsigned char* payload,
                        uint16_t len)
 {
-    unsigned char pkt[8 + MAX_PAYLOAD + 1];
-    if (len > MAX_PAYLOAD){ fprintf(stderr, "payload too large\n"); return -1; }
-
-    pkt[0]=MAGIC1; pkt[1]=MAGIC2;
-    pkt[2]=type;
-    pkt[3]=priority;
-    pkt[4]=flags;
-    pkt[5]=ttl; // Relay 在路上遞減；若啟 SELF_DESTRUCT 且變 0 → 回 NACK
-    pkt[6]=len & 0xFF; pkt[7]=(len>>8)&0xFF;
-    memcpy(&pkt[8], payload, len);
-    pkt[8+len] = xor_checksum(payload, len);
-
-    int n = send(s, (const char*)pkt, 8 + len + 1, 0);
-    if (n == SOCKET_ERROR){ fprintf(stderr, "send error\n"); return -1; }
-
-    printf("已送出：type=0x%02X prio=%u flags=0x%02X ttl=%u len=%u\n",
-           type, priority, flags, ttl, len);
-    return 0;
+    unsigned char pkt[MAX_PKT];
+    // ttl：Relay 在路上遞減；若啟 SELF_DESTRUCT 且變 0 → 回 NACK
+    return send_frame(s, pkt, pf_build(pkt, sizeof(pkt), type, priority, flags, ttl, payload, len));
 }
 
 // 等待 ACK/NACK（含 timeout）；回：0=ACK、1=NACK_SD、-1=timeout
@@ -89,17 +47,14 @@ static int wait_ack_or_nack(SOCKET s, int timeout_ms){
     int r = select((int)(s+1), &rset, NULL, NULL, &tv);
     if (r <= 0) return -1;
 
-    unsigned char buf[8 + MAX_PAYLOAD + 1];
+    unsigned char buf[MAX_PKT];
     int n = recv(s, (char*)buf, sizeof(buf), 0);
     if (n <= 0) return -1;
 
-    if (n < 9 || buf[0]!=MAGIC1 || buf[1]!=MAGIC2) return -1;
+    uint16_t L;
+    if (pf_validate(buf, n, &L) != PF_OK) return -1;
     unsigned char type = buf[2];
-    uint16_t L = (uint16_t)(buf[6] | (buf[7]<<8));
-    if (8 + L + 1 != n) return -1;
-
-    unsigned char* payload = &buf[8];
-    if (xor_checksum(payload, L) != buf[8+L]) return -1;
+    unsigned char* payload = pf_payload(buf);
 
     if (type == TYPE_ACK){
         printf("[Client] 收到 ACK：%.*s\n", L, (char*)payload);
@@ -196,7 +151,9 @@ int main(void){
             trim_newline(msgbuf);
             const char* use = (msgbuf[0]) ? msgbuf : "AAAAABBBCCCCCCCCDD";
 
-            unsigned char comp[MAX_PAYLOAD];
+            // 直接壓縮進封包的 payload 區，免再複製一次
+            unsigned char pkt[MAX_PKT];
+            unsigned char* comp = pf_payload(pkt);
             int clen = rle_compress((const unsigned char*)use, (int)strlen(use), comp, MAX_PAYLOAD);
             if (clen < 0){ printf("RLE 壓縮失敗\n"); break; }
 
@@ -206,8 +163,8 @@ int main(void){
             for (int i = 0; i < clen; ++i) printf("%02X ", comp[i]);
             printf("\n");
 
-            send_packet(s, TYPE_DATA, PRIO_MEDIA, FLAG_REQUIRE_ACK | FLAG_COMPRESSED, 3,
-                        comp, (uint16_t)clen);
+            send_frame(s, pkt, pf_seal(pkt, TYPE_DATA, PRIO_MEDIA, FLAG_REQUIRE_ACK | FLAG_COMPRESSED, 3,
+                                       (uint16_t)clen));
             int r = wait_ack_or_nack(s, 1500);
             if (r != 0) printf("未獲 ACK（ret=%d）\n", r);
             break;
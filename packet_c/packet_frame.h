@@ -0,0 +1,231 @@
+// packet_frame.h — Client / Relay / Server 共用的封包編碼器（header-only）
+//
+// 格式 : [0]AA [1]BB [2]type [3]priority [4]flags [5]ttl [6]len_lo [7]len_hi [8..]payload [end]checksum(payload XOR)
+//
+// C11 核心：直接把 header 寫進呼叫端提供的 buffer，payload 可事先就地寫在 pf_payload() 位置，
+// 省掉一次複製；固定內容的 ACK/NACK 控制封包由前置處理器從同一串字元展開出長度欄位與 checksum，
+// 編譯期就是完整的 byte 陣列，送出時只需 memcpy + 改 priority。
+// 以 C++14 以上編譯時另提供 constexpr 版本，並用 static_assert 與 C 的常數表互相核對。
+#ifndef PACKET_FRAME_H
+#define PACKET_FRAME_H
+
+#include <stdint.h>
+#include <string.h>
+
+// 協定常數
+#define MAGIC1 0xAA
+#define MAGIC2 0xBB
+
+#define TYPE_DATA       0x01
+#define TYPE_HEARTBEAT  0x02
+#define TYPE_ACK        0xA0
+#define TYPE_NACK_SD    0xA1
+
+#define FLAG_REQUIRE_ACK        0x01
+#define FLAG_SELF_DESTRUCT_EN   0x02 // 由 relay 處理
+#define FLAG_COMPRESSED         0x04 // P3 壓縮
+
+// priorities（應用層語義）
+#define PRIO_DELAYED    0   // P0：延遲顯示
+#define PRIO_IMMEDIATE  1   // P1：立即顯示
+#define PRIO_EPHEMERAL  2   // P2：輕量/短暫
+#define PRIO_MEDIA      3   // P3：允許壓縮，server 自動解壓
+
+#define MAX_PAYLOAD 1024
+#define PF_HDR_LEN  8
+#define MAX_PKT     (PF_HDR_LEN + MAX_PAYLOAD + 1)
+
+#define PF_CTRL_TTL 3   // 回覆用 ttl
+
+// pf_validate 回傳值
+#define PF_OK         0
+#define PF_ERR_MAGIC -1 // 太短或 header 不對
+#define PF_ERR_LEN   -2 // 長度欄位與實際收到的不符
+#define PF_ERR_CKSUM -3 // checksum 錯誤
+
+static inline unsigned char pf_checksum(const unsigned char* data, uint16_t len){
+    unsigned char s = 0;
+    for (uint16_t i = 0; i < len; ++i) s ^= data[i];
+    return s;
+}
+
+static inline unsigned char* pf_payload(unsigned char* frame){ return frame + PF_HDR_LEN; }
+
+static inline void pf_put_header(unsigned char* frame,
+                                 unsigned char type,
+                                 unsigned char priority,
+                                 unsigned char flags,
+                                 unsigned char ttl,
+                                 uint16_t len)
+{
+    frame[0]=MAGIC1; frame[1]=MAGIC2;
+    frame[2]=type;
+    frame[3]=priority;
+    frame[4]=flags;
+    frame[5]=ttl;
+    frame[6]=len & 0xFF; frame[7]=(len>>8)&0xFF;
+}
+
+// payload 已在 pf_payload(frame) 就地寫好 → 補上 header 與 checksum；回：整個封包長度，-1=payload 過大
+static inline int pf_seal(unsigned char* frame,
+                          unsigned char type,
+                          unsigned char priority,
+                          unsigned char flags,
+                          unsigned char ttl,
+                          uint16_t len)
+{
+    if (len > MAX_PAYLOAD) return -1;
+    pf_put_header(frame, type, priority, flags, ttl, len);
+    frame[PF_HDR_LEN + len] = pf_checksum(&frame[PF_HDR_LEN], len);
+    return PF_HDR_LEN + len + 1;
+}
+
+// 把 payload 複製進 frame 再封裝；cap 為 frame 可用大小。回：封包長度，-1=放不下
+static inline int pf_build(unsigned char* frame, int cap,
+                           unsigned char type,
+                           unsigned char priority,
+                           unsigned char flags,
+                           unsigned char ttl,
+                           const unsigned char* payload,
+                           uint16_t len)
+{
+    if (len > MAX_PAYLOAD || PF_HDR_LEN + len + 1 > cap) return -1;
+    memcpy(&frame[PF_HDR_LEN], payload, len);
+    return pf_seal(frame, type, priority, flags, ttl, len);
+}
+
+// 複製預先算好的控制封包，只改 priority 欄位（checksum 只涵蓋 payload，不需重算）；cap 為 frame 可用大小。
+// 回：封包長度，-1=放不下
+static inline int pf_ctrl(unsigned char* frame, int cap, const unsigned char* tmpl, int n, unsigned char ref_prio){
+    if (n > cap) return -1;
+    memcpy(frame, tmpl, (size_t)n);
+    frame[3] = ref_prio;
+    return n;
+}
+
+// 驗證收到的封包：至少 9 bytes；header 正確；長度匹配；checksum 正確。成功時 *out_len = payload 長度
+static inline int pf_validate(const unsigned char* buf, int n, uint16_t* out_len){
+    if (n < PF_HDR_LEN + 1 || buf[0]!=MAGIC1 || buf[1]!=MAGIC2) return PF_ERR_MAGIC;
+    uint16_t L = (uint16_t)(buf[6] | (buf[7]<<8));
+    if (PF_HDR_LEN + L + 1 != n) return PF_ERR_LEN;
+    if (pf_checksum(&buf[PF_HDR_LEN], L) != buf[PF_HDR_LEN + L]) return PF_ERR_CKSUM;
+    if (out_len) *out_len = L;
+    return PF_OK;
+}
+
+// ---- 預先編好的控制封包（priority 欄位為 0，送出時由 pf_ctrl 填入） ----
+#ifdef __cplusplus
+#define PF_CONST static constexpr
+#else
+#define PF_CONST static const
+#endif
+
+#define PF_CTRL_HDR(type, len) MAGIC1, MAGIC2, (type), 0, 0, PF_CTRL_TTL, (len) & 0xFF, ((len)>>8) & 0xFF
+
+// 控制封包的 payload 以字元清單給出，長度與 checksum 都由同一份清單展開（最多 32 字元）
+#define PF_EXPAND(x) x // MSVC 傳統前置處理器需要多展開一次 __VA_ARGS__
+#define PF_NARGS(...) PF_EXPAND(PF_NARGS_(__VA_ARGS__, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1))
+#define PF_NARGS_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, n, ...) n
+#define PF_CAT(a, b) PF_CAT_(a, b)
+#define PF_CAT_(a, b) a##b
+#define PF_XOR(...) PF_EXPAND(PF_CAT(PF_XOR_, PF_NARGS(__VA_ARGS__))(__VA_ARGS__))
+#define PF_XOR_1(a) (a)
+#define PF_XOR_2(a, ...) ((a) ^ PF_EXPAND(PF_XOR_1(__VA_ARGS__)))
+#define PF_XOR_3(a, ...) ((a) ^ PF_EXPAND(PF_XOR_2(__VA_ARGS__)))
+#define PF_XOR_4(a, ...) ((a) ^ PF_EXPAND(PF_XOR_3(__VA_ARGS__)))
+#define PF_XOR_5(a, ...) ((a) ^ PF_EXPAND(PF_XOR_4(__VA_ARGS__)))
+#define PF_XOR_6(a, ...) ((a) ^ PF_EXPAND(PF_XOR_5(__VA_ARGS__)))
+#define PF_XOR_7(a, ...) ((a) ^ PF_EXPAND(PF_XOR_6(__VA_ARGS__)))
+#define PF_XOR_8(a, ...) ((a) ^ PF_EXPAND(PF_XOR_7(__VA_ARGS__)))
+#define PF_XOR_9(a, ...) ((a) ^ PF_EXPAND(PF_XOR_8(__VA_ARGS__)))
+#define PF_XOR_10(a, ...) ((a) ^ PF_EXPAND(PF_XOR_9(__VA_ARGS__)))
+#define PF_XOR_11(a, ...) ((a) ^ PF_EXPAND(PF_XOR_10(__VA_ARGS__)))
+#define PF_XOR_12(a, ...) ((a) ^ PF_EXPAND(PF_XOR_11(__VA_ARGS__)))
+#define PF_XOR_13(a, ...) ((a) ^ PF_EXPAND(PF_XOR_12(__VA_ARGS__)))
+#define PF_XOR_14(a, ...) ((a) ^ PF_EXPAND(PF_XOR_13(__VA_ARGS__)))
+#define PF_XOR_15(a, ...) ((a) ^ PF_EXPAND(PF_XOR_14(__VA_ARGS__)))
+#define PF_XOR_16(a, ...) ((a) ^ PF_EXPAND(PF_XOR_15(__VA_ARGS__)))
+#define PF_XOR_17(a, ...) ((a) ^ PF_EXPAND(PF_XOR_16(__VA_ARGS__)))
+#define PF_XOR_18(a, ...) ((a) ^ PF_EXPAND(PF_XOR_17(__VA_ARGS__)))
+#define PF_XOR_19(a, ...) ((a) ^ PF_EXPAND(PF_XOR_18(__VA_ARGS__)))
+#define PF_XOR_20(a, ...) ((a) ^ PF_EXPAND(PF_XOR_19(__VA_ARGS__)))
+#define PF_XOR_21(a, ...) ((a) ^ PF_EXPAND(PF_XOR_20(__VA_ARGS__)))
+#define PF_XOR_22(a, ...) ((a) ^ PF_EXPAND(PF_XOR_21(__VA_ARGS__)))
+#define PF_XOR_23(a, ...) ((a) ^ PF_EXPAND(PF_XOR_22(__VA_ARGS__)))
+#define PF_XOR_24(a, ...) ((a) ^ PF_EXPAND(PF_XOR_23(__VA_ARGS__)))
+#define PF_XOR_25(a, ...) ((a) ^ PF_EXPAND(PF_XOR_24(__VA_ARGS__)))
+#define PF_XOR_26(a, ...) ((a) ^ PF_EXPAND(PF_XOR_25(__VA_ARGS__)))
+#define PF_XOR_27(a, ...) ((a) ^ PF_EXPAND(PF_XOR_26(__VA_ARGS__)))
+#define PF_XOR_28(a, ...) ((a) ^ PF_EXPAND(PF_XOR_27(__VA_ARGS__)))
+#define PF_XOR_29(a, ...) ((a) ^ PF_EXPAND(PF_XOR_28(__VA_ARGS__)))
+#define PF_XOR_30(a, ...) ((a) ^ PF_EXPAND(PF_XOR_29(__VA_ARGS__)))
+#define PF_XOR_31(a, ...) ((a) ^ PF_EXPAND(PF_XOR_30(__VA_ARGS__)))
+#define PF_XOR_32(a, ...) ((a) ^ PF_EXPAND(PF_XOR_31(__VA_ARGS__)))
+
+#define PF_CTRL_FRAME(type, ...) \
+    { PF_CTRL_HDR(type, PF_NARGS(__VA_ARGS__)), __VA_ARGS__, PF_XOR(__VA_ARGS__) }
+
+#ifdef __cplusplus
+#define PF_STATIC_ASSERT(cond, msg) static_assert(cond, msg)
+#else
+#define PF_STATIC_ASSERT(cond, msg) _Static_assert(cond, msg)
+#endif
+
+PF_CONST unsigned char PF_FRAME_ACK[] =
+    PF_CTRL_FRAME(TYPE_ACK, 'A','C','K');
+PF_CONST unsigned char PF_FRAME_ACK_HEARTBEAT[] =
+    PF_CTRL_FRAME(TYPE_ACK, 'A','C','K','_','H','E','A','R','T','B','E','A','T');
+PF_CONST unsigned char PF_FRAME_NACK_SD[] =
+    PF_CTRL_FRAME(TYPE_NACK_SD, 'S','E','L','F','_','D','E','S','T','R','U','C','T','E','D','@','R','E','L','A','Y');
+
+// 字元清單須與文字一致（長度欄位與 checksum 皆由清單展開，這裡核對清單本身）
+#define PF_CTRL_SIZE(text) (PF_HDR_LEN + sizeof(text) - 1 + 1)
+PF_STATIC_ASSERT(sizeof(PF_FRAME_ACK) == PF_CTRL_SIZE("ACK"), "PF_FRAME_ACK");
+PF_STATIC_ASSERT(sizeof(PF_FRAME_ACK_HEARTBEAT) == PF_CTRL_SIZE("ACK_HEARTBEAT"), "PF_FRAME_ACK_HEARTBEAT");
+PF_STATIC_ASSERT(sizeof(PF_FRAME_NACK_SD) == PF_CTRL_SIZE("SELF_DESTRUCTED@RELAY"), "PF_FRAME_NACK_SD");
+
+// server 送 ACK 用的 buffer 大小（容納最大的 ACK 範本）
+#define PF_ACK_MAX (sizeof(PF_FRAME_ACK) > sizeof(PF_FRAME_ACK_HEARTBEAT) ? sizeof(PF_FRAME_ACK) : sizeof(PF_FRAME_ACK_HEARTBEAT))
+
+// constexpr 迴圈需要 C++14（MSVC 未加 /Zc:__cplusplus 時以 _MSVC_LANG 判斷）
+#if defined(__cplusplus) && (__cplusplus >= 201402L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L))
+#include <cstddef>
+
+namespace pf {
+
+template <std::size_t N>
+struct frame {
+    unsigned char bytes[N];
+    static constexpr std::size_t size(){ return N; }
+};
+
+// 編譯期由字串常數產生完整控制封包：pf::control_frame<TYPE_ACK>("ACK")
+template <unsigned char Type, std::size_t N>
+constexpr frame<PF_HDR_LEN + (N - 1) + 1> control_frame(const char (&txt)[N]){
+    frame<PF_HDR_LEN + (N - 1) + 1> f{};
+    const unsigned char hdr[PF_HDR_LEN] = { PF_CTRL_HDR(Type, N - 1) };
+    unsigned char ck = 0;
+    for (std::size_t i = 0; i < PF_HDR_LEN; ++i) f.bytes[i] = hdr[i];
+    for (std::size_t i = 0; i < N - 1; ++i){
+        f.bytes[PF_HDR_LEN + i] = (unsigned char)txt[i];
+        ck ^= (unsigned char)txt[i];
+    }
+    f.bytes[PF_HDR_LEN + N - 1] = ck;
+    return f;
+}
+
+template <std::size_t N, std::size_t M>
+constexpr bool same(const frame<N>& f, const unsigned char (&tbl)[M]){
+    if (N != M) return false;
+    for (std::size_t i = 0; i < N; ++i) if (f.bytes[i] != tbl[i]) return false;
+    return true;
+}
+
+static_assert(same(control_frame<TYPE_ACK>("ACK"), PF_FRAME_ACK), "PF_FRAME_ACK");
+static_assert(same(control_frame<TYPE_ACK>("ACK_HEARTBEAT"), PF_FRAME_ACK_HEARTBEAT), "PF_FRAME_ACK_HEARTBEAT");
+static_assert(same(control_frame<TYPE_NACK_SD>("SELF_DESTRUCTED@RELAY"), PF_FRAME_NACK_SD), "PF_FRAME_NACK_SD");
+
+} // namespace pf
+#endif
+
+#endif // PACKET_FRAME_H
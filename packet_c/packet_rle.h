@@ -0,0 +1,32 @@
+// packet_rle.h — P3 多媒體封包使用的簡易 RLE（client 壓縮、server 解壓；bench/ 亦直接量測這份實作）
+#ifndef PACKET_RLE_H
+#define PACKET_RLE_H
+
+// 簡易 RLE 壓縮：AAABBB → [5 'A'][3 'B']
+static inline int rle_compress(const unsigned char* in, int inlen, unsigned char* out, int outcap){
+    int oi = 0;
+    for (int i=0; i<inlen; ){
+        unsigned char v = in[i];
+        int cnt = 1;
+        while (i+cnt < inlen && in[i+cnt]==v && cnt < 255) cnt++;
+        if (oi + 2 > outcap) return -1;
+        out[oi++] = (unsigned char)cnt;
+        out[oi++] = v;
+        i += cnt;
+    }
+    return oi;
+}
+
+// 簡易 RLE 解壓：[count][value]
+static inline int rle_decompress(const unsigned char* in, int inlen, unsigned char* out, int outcap){
+    int oi = 0;
+    for (int i = 0; i + 1 < inlen; i += 2){
+        int cnt = in[i];
+        unsigned char v = in[i+1];
+        if (oi + cnt > outcap) return -1;
+        for (int k = 0; k < cnt; ++k) out[oi++] = v;
+    }
+    return oi;
+}
+
+#endif // PACKET_RLE_H
@@ -6,69 +6,25 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "packet_frame.h"
+#include "packet_rle.h"
+
 #pragma comment(lib, "ws2_32.lib")
 
 #define SERVER_PORT 8888
 #define MAX_CLIENTS FD_SETSIZE
-#define MAX_PAYLOAD 1024
-
-// 協定常數
-#define MAGIC1 0xAA
-#define MAGIC2 0xBB
-
-// type
-#define TYPE_DATA       0x01
-#define TYPE_HEARTBEAT  0x02
-#define TYPE_ACK        0xA0
-
-// flags
-#define FLAG_REQUIRE_ACK        0x01
-#define FLAG_SELF_DESTRUCT_EN   0x02 // 由 relay 處理
-#define FLAG_COMPRESSED         0x04 // P3 壓縮
-
-// priorities（應用層語義）
-#define PRIO_DELAYED    0   // P0：延遲顯示
-#define PRIO_IMMEDIATE  1   // P1：立即顯示
-#define PRIO_EPHEMERAL  2   // P2：輕量/短暫
-#define PRIO_MEDIA      3   // P3：允許壓縮，server 自動解壓
-
-static unsigned char xor_checksum(const unsigned char* data, uint16_t len){
-    unsigned char s = 0;
-    for (uint16_t i = 0; i < len; ++i) s ^= data[i];
-    return s;
-}
 
 static void print_hex(const unsigned char* buf, int n){
     for (int i = 0; i < n; ++i) printf("%02X ", buf[i]);
     printf("\n");
 }
 
-// 簡易 RLE 解壓：[count][value]
-static int rle_decompress(const unsigned char* in, int inlen, unsigned char* out, int outcap){
-    int oi = 0;
-    for (int i = 0; i + 1 < inlen; i += 2){
-        int cnt = in[i];
-        unsigned char v = in[i+1];
-        if (oi + cnt > outcap) return -1;
-        for (int k = 0; k < cnt; ++k) out[oi++] = v;
-    }
-    return oi;
-}
-
-// 回 ACK（把原 priority 放進回封包的 priority 欄位便於除錯）
-static void send_ack(SOCKET s, unsigned char ref_prio, const char* text){
-    unsigned char pkt[8 + 64 + 1];
-    const char* msg = (text && *text) ? text : "ACK";
-    uint16_t L = (uint16_t)strlen(msg);
-    pkt[0]=MAGIC1; pkt[1]=MAGIC2;
-    pkt[2]=TYPE_ACK;
-    pkt[3]=ref_prio;
-    pkt[4]=0;      // flags
-    pkt[5]=3;      // ttl（回覆用）
-    pkt[6]=L & 0xFF; pkt[7]=(L>>8)&0xFF;
-    memcpy(&pkt[8], msg, L);
-    pkt[8+L] = xor_checksum((unsigned char*)msg, L);
-    send(s, (const char*)pkt, 8 + L + 1, 0);
+// 回 ACK（把原 priority 放進回封包的 priority 欄位便於除錯）；frame 為 packet_frame.h 預先編好的 PF_FRAME_ACK*
+static void send_ack(SOCKET s, unsigned char ref_prio, const unsigned char* frame, int n){
+    unsigned char pkt[PF_ACK_MAX];
+    int plen = pf_ctrl(pkt, sizeof(pkt), frame, n, ref_prio);
+    if (plen < 0){ printf("ACK frame too large\n"); return; }
+    send(s, (const char*)pkt, plen, 0);
 }
 
 // 將非可列印字元替換成 '.' 以便在表格預覽 Payload
@@ -146,7 +102,7 @@ int main(void){
     FD_SET(listen_fd, &allset);
     int maxfd = (int)listen_fd;
 
-    unsigned char buf[8 + MAX_PAYLOAD + 1];
+    unsigned char buf[MAX_PKT];
 
     for (;;){
         rset = allset;
@@ -186,17 +142,17 @@ int main(void){
                 continue;
             }
 
-            if (n < 9 || buf[0]!=MAGIC1 || buf[1]!=MAGIC2){ printf("bad packet\n"); continue; }
+            uint16_t L;
+            int vr = pf_validate(buf, n, &L);
+            if (vr == PF_ERR_MAGIC){ printf("bad packet\n"); continue; }
+            if (vr == PF_ERR_LEN){ printf("len mismatch\n"); continue; }
+            if (vr == PF_ERR_CKSUM){ printf("checksum error\n"); continue; }
+
             unsigned char type = buf[2];
             unsigned char prio = buf[3];
             unsigned char flags= buf[4];
             // [5]自毀功能在relay完成
-            uint16_t L = (uint16_t)(buf[6] | (buf[7]<<8));
-            if (8 + L + 1 != n){ printf("len mismatch\n"); continue; }
-
-            unsigned char* payload = &buf[8];
-            unsigned char ck = buf[8+L];
-            if (ck != xor_checksum(payload, L)){ printf("checksum error\n"); continue; }
+            unsigned char* payload = pf_payload(buf);
 
             printf("\n=== Packet === type=0x%02X prio=%u flags=0x%02X len=%u\n", type, prio, flags, L);
 
@@ -222,11 +178,11 @@ int main(void){
                 }
 
                 if (flags & FLAG_REQUIRE_ACK){
-                    send_ack(cs, prio, "ACK");
+                    send_ack(cs, prio, PF_FRAME_ACK, sizeof(PF_FRAME_ACK));
                 }
             } else if (type == TYPE_HEARTBEAT){
                 printf("[心跳] 收到 HEARTBEAT → 回 ACK\n");
-                send_ack(cs, prio, "ACK_HEARTBEAT");
+                send_ack(cs, prio, PF_FRAME_ACK_HEARTBEAT, sizeof(PF_FRAME_ACK_HEARTBEAT));
             } else {
                 printf("[其他 type=0x%02X]\n", type);
             }
@@ -9,21 +9,7 @@
 
 #pragma comment(lib, "ws2_32.lib")
 
-// 協定常數
-#define MAGIC1 0xAA
-#define MAGIC2 0xBB
-
-#define TYPE_DATA       0x01
-#define TYPE_HEARTBEAT  0x02
-#define TYPE_ACK        0xA0
-#define TYPE_NACK_SD    0xA1
-
-#define FLAG_REQUIRE_ACK        0x01
-#define FLAG_SELF_DESTRUCT_EN   0x02
-#define FLAG_COMPRESSED         0x04
-
-#define MAX_PAYLOAD 1024
-#define MAX_PKT (8 + MAX_PAYLOAD + 1)
+#include "packet_frame.h"
 
 static int   g_listen_port = 7777;       // Relay 對 client 監聽
 static char  g_up_ip[64]   = "127.0.0.1";// 上游 server IP
@@ -32,11 +18,6 @@ static int   g_delay_ms    = 0;          // 固定延遲（毫秒）
 static float g_drop_prob   = 0.0f;       // 機率丟包（0.0~1.0）(但沒時間做相應機制，可以當不存在)
 static int   g_verbose     = 1;
 
-static unsigned char xor_checksum(const unsigned char* data, uint16_t len){
-    unsigned char s = 0;
-    for (uint16_t i=0; i<len; ++i) s ^= data[i];
-    return s;
-}
 static void msleep(int ms){ if (ms > 0) Sleep(ms); }
 
 static void parse_argv(int argc, char** argv){
@@ -49,18 +30,11 @@ static void parse_argv(int argc, char** argv){
 
 // 回 NACK(SELF_DESTRUCTED) 告知 client 在路上自毀，讓 client 立刻重傳
 static void send_nack_sd(SOCKET to_client, unsigned char ref_prio){
-    const char* txt = "SELF_DESTRUCTED@RELAY";
-    uint16_t L = (uint16_t)strlen(txt);
-    unsigned char pkt[8 + 64 + 1];
-    pkt[0]=MAGIC1; pkt[1]=MAGIC2;
-    pkt[2]=TYPE_NACK_SD;
-    pkt[3]=ref_prio;          // 帶 priority 便於除錯
-    pkt[4]=0;
-    pkt[5]=3;
-    pkt[6]=L & 0xFF; pkt[7]=(L>>8)&0xFF;
-    memcpy(&pkt[8], txt, L);
-    pkt[8+L] = xor_checksum((unsigned char*)txt, L);
-    send(to_client, (const char*)pkt, 8 + L + 1, 0);
+    unsigned char pkt[sizeof(PF_FRAME_NACK_SD)];
+    // 預先編好的 "SELF_DESTRUCTED@RELAY"，只帶入 priority 便於除錯
+    int plen = pf_ctrl(pkt, sizeof(pkt), PF_FRAME_NACK_SD, sizeof(PF_FRAME_NACK_SD), ref_prio);
+    if (plen < 0) return;
+    send(to_client, (const char*)pkt, plen, 0);
 }
 
 // 原樣轉送（C->S 或 S->C）
@@ -130,40 +104,37 @@ int main(int argc, char** argv){
                 if (n <= 0){ printf("client closed\n"); break; }
 
                 // 解析自訂封包：至少 9 bytes；header 正確；長度匹配；checksum 正確
-                if (n >= 9 && buf[0]==MAGIC1 && buf[1]==MAGIC2){
+                uint16_t L;
+                if (pf_validate(buf, n, &L) == PF_OK){
                     unsigned char type = buf[2];
                     unsigned char prio = buf[3];
                     unsigned char flags= buf[4];
                     unsigned char ttl  = buf[5];
-                    uint16_t L = (uint16_t)(buf[6] | (buf[7]<<8));
-
-                    if (8 + L + 1 == n && xor_checksum(&buf[8], L) == buf[8+L]){
-                        if (g_verbose) printf("[Relay] C->R type=0x%02X prio=%u flags=0x%02X ttl=%u len=%u\n",
-                                              type, prio, flags, ttl, L);
-                        // 1) 在路上遞減 TTL
-                        if (ttl > 0){ ttl -= 1; buf[5] = ttl; }
-
-                        // 2) 在路上自毀：啟用 SELF_DESTRUCT 且 TTL 歸零
-                        if ((flags & FLAG_SELF_DESTRUCT_EN) && ttl == 0){
-                            printf("[Relay] SELF_DESTRUCT → drop & NACK to client\n");
-                            send_nack_sd(cs, prio);
-                            continue; // 不轉送 server
-                        }
+                    if (g_verbose) printf("[Relay] C->R type=0x%02X prio=%u flags=0x%02X ttl=%u len=%u\n",
+                                          type, prio, flags, ttl, L);
+                    // 1) 在路上遞減 TTL
+                    if (ttl > 0){ ttl -= 1; buf[5] = ttl; }
+
+                    // 2) 在路上自毀：啟用 SELF_DESTRUCT 且 TTL 歸零
+                    if ((flags & FLAG_SELF_DESTRUCT_EN) && ttl == 0){
+                        printf("[Relay] SELF_DESTRUCT → drop & NACK to client\n");
+                        send_nack_sd(cs, prio);
+                        continue; // 不轉送 server
+                    }
 
-                        // 3) 壅塞模擬：延遲 + 機率丟包 (尚未做相應措施，可當不存在XD)
-                        if (g_delay_ms > 0) msleep(g_delay_ms);
-                        if (g_drop_prob > 0.0f){
-                            float p = (float)rand() / (float)RAND_MAX;
-                            if (p < g_drop_prob){
-                                printf("[Relay] drop by probability\n");
-                                continue; // 直接丟棄
-                            }
+                    // 3) 壅塞模擬：延遲 + 機率丟包 (尚未做相應措施，可當不存在XD)
+                    if (g_delay_ms > 0) msleep(g_delay_ms);
+                    if (g_drop_prob > 0.0f){
+                        float p = (float)rand() / (float)RAND_MAX;
+                        if (p < g_drop_prob){
+                            printf("[Relay] drop by probability\n");
+                            continue; // 直接丟棄
                         }
-
-                        // 4) 正常前送到 server
-                        if (forward_packet(us, buf, n) < 0){ printf("forward upstream failed\n"); break; }
-                        continue;
                     }
+
+                    // 4) 正常前送到 server
+                    if (forward_packet(us, buf, n) < 0){ printf("forward upstream failed\n"); break; }
+                    continue;
                 }
 
                 // 非自訂封包/驗證失敗 -> 原樣轉送